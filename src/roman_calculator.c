@@ -10,9 +10,14 @@
  * Repository:
  *     https://github.com/drmrd/roman-calculator
  */
+#define _POSIX_C_SOURCE 200809L
+#include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include "roman_calculator.h"
 
 /**
  * One of a few arabic numbers that has slipped into this program to help add
@@ -26,7 +31,9 @@
  * this, but this limitation would not be encountered by the average Roman
  * accountant.
  */
+#ifndef MAX_NUMERAL_LENGTH
 #define MAX_NUMERAL_LENGTH 5000
+#endif
 /**
  * The maximum amount that the size of a string will grow due to replacing a
  * single instance of a subtractive form in the string with its additive
@@ -40,6 +47,24 @@
  * MAX_NUMERAL_LENGTH.
  */
 #define INFINITAS "Infinitas"
+/**
+ * Once either input to a calculation reaches PARALLEL_THRESHOLD characters,
+ * the calculator stops rewriting its inputs as strings and instead tallies
+ * their symbols directly. Each numeral at least that long is cut into chunks
+ * (one per tally thread, up to MAX_TALLY_THREADS) at positions that don't split
+ * a subtractive pair, the chunks are tallied in separate threads, and the
+ * per-chunk tallies are merged before carrying and rendering the result. The
+ * threshold can be overridden at compile time or changed at runtime with
+ * set_roman_parallel_threshold, and the number of threads with
+ * set_roman_tally_threads (zero, the default, means one per online processor).
+ */
+#ifndef PARALLEL_THRESHOLD
+#define PARALLEL_THRESHOLD (1 << 20)
+#endif
+#define MAX_TALLY_THREADS 64
+
+static size_t parallel_threshold = PARALLEL_THRESHOLD;
+static size_t tally_threads = 0;
 
 /**
  * To avoid writing down Arabic numerals (0, 1, 2, ...) explicitly in the
@@ -101,6 +126,62 @@ int conversion_table[RN_LAST][RN_LAST] = {
     {1000, 200, 100, 20, 10, 2, 1}
 };
 
+/**
+ * Lookup tables used to render binary integers in bulk (see
+ * roman_from_uint32_array). Row k holds the Roman spelling of each decimal
+ * digit in the k-th place, using the same subtractive forms the calculator
+ * outputs, and roman_digit_lengths holds the length of each spelling, which is
+ * the same in every place. Thousands are written as runs of M.
+ */
+static const char *roman_digits[][10] = {
+    {"", "I", "II", "III", "IV", "V", "VI", "VII", "VIII", "IX"},
+    {"", "X", "XX", "XXX", "XL", "L", "LX", "LXX", "LXXX", "XC"},
+    {"", "C", "CC", "CCC", "CD", "D", "DC", "DCC", "DCCC", "CM"}
+};
+static const size_t roman_digit_lengths[10] = {0, 1, 2, 3, 2, 1, 2, 3, 4, 2};
+#define ROMAN_DIGIT_PLACES (sizeof(roman_digits) / sizeof(roman_digits[0]))
+
+/**
+ * Lookup tables for tallying numerals a byte at a time, filled in once by
+ * build_tally_tables. symbol_keys maps every character to its (enum
+ * Roman_Numeral), sending unknown characters to RN_M just as get_key does;
+ * subtractive_pair_form maps a pair of symbols to the (enum Subtractive_Form)
+ * they spell, or SF_LAST; and subtractive_form_counts holds the number of each
+ * symbol in the additive substitute for every subtractive form.
+ */
+static pthread_once_t tally_tables_once = PTHREAD_ONCE_INIT;
+static unsigned char symbol_keys[UCHAR_MAX + 1];
+static enum Subtractive_Form subtractive_pair_form[RN_LAST][RN_LAST];
+static long subtractive_form_counts[SF_LAST][RN_LAST];
+
+/**
+ * A contiguous run [start, stop) of the numeral [numeral, numeral_stop), along
+ * with the number of each symbol it contains once written additively and
+ * whether it contains an ambiguous subtractive pair. Used by the tally path.
+ */
+struct Tally_Chunk {
+    const char *numeral;
+    const char *numeral_stop;
+    const char *start;
+    const char *stop;
+    long symbol_counts[RN_LAST];
+    int ambiguous;
+};
+
+static char *add_large_roman_numerals(char *augend, char *addend);
+static enum Roman_Status tally_numeral(const char *numeral,
+                                       long symbol_counts[]);
+static void build_tally_tables(void);
+static const char *next_safe_boundary(const char *position, const char *stop);
+static void *tally_chunk(void *chunk);
+static int is_ambiguous_numeral(const char *numeral);
+static int is_ambiguous_pair(const char *pair, const char *numeral,
+                             const char *stop);
+static void carry_symbol_counts(long symbol_counts[]);
+static unsigned long long tally_value(const long symbol_counts[]);
+static size_t uint32_numeral_length(uint32_t value);
+static char *write_uint32_numeral(uint32_t value, char *destination);
+static char *render_symbol_counts(long symbol_counts[]);
 static char *write_additively(char *roman_numeral);
 static enum Roman_Numeral get_key(char symbol);
 static char *add_additive_roman_numerals(char *augend, char *addend,
@@ -122,6 +203,16 @@ static char *my_strdup (const char *string);
  */
 char *add_roman_numerals(char *augend, char *addend)
 {
+    if (strlen(augend) >= parallel_threshold
+        || strlen(addend) >= parallel_threshold) {
+        return add_large_roman_numerals(augend, addend);
+    }
+
+    // Both paths refuse numerals they could read differently (see README).
+    if (is_ambiguous_numeral(augend) || is_ambiguous_numeral(addend)) {
+        return NULL;
+    }
+
     // Rewrite augend and addend without subtractive forms
     char *summandI = write_additively(augend);
     char *summandII = write_additively(addend);
@@ -166,76 +257,563 @@ char *add_roman_numerals(char *augend, char *addend)
  *     minuend and subtrahend, again represented as strings.
  *
  *     Since we are in Roman times, neither zero nor negative numbers have been
- *     discovered yet, and so the code will fail to produce a Roman numeral if
- *     minuend is less than or equal to subtrahend.
+ *     discovered yet, and so NULL is returned if minuend is less than or equal
+ *     to subtrahend (or if either is ambiguous). Use
+ *     try_subtract_roman_numerals to find out why.
  */
 char *subtract_roman_numerals(char *minuend, char *subtrahend)
 {
-    /*
-     * Count up the number of each symbol in summandI and then subtract the
-     * number of appearances of that symbol in summandII.
-     */
-    char *summandI = write_additively(minuend);
-    char *summandII = write_additively(subtrahend);
-    minuend = summandI;
-    subtrahend = summandII;
-
-    int tally[RN_LAST] = {0};
-    int result_members = 1; // 1 to account for terminal '\0'
-    int exchange_rate;
-    enum Roman_Numeral symbol, symbolII; // Again for use while iterating below
-
-    // TODO: DRY these out
-    for(; *minuend; result_members++, tally[get_key(*minuend)]++, minuend++);
-    for(; *subtrahend; result_members--, tally[get_key(*subtrahend)]--, subtrahend++);
-    free(summandI);
-    free(summandII);
+    char *difference = NULL;
+    try_subtract_roman_numerals(minuend, subtrahend, &difference);
+    return difference;
+}
+
+/**
+ * try_subtract_roman_numerals(minuend, subtrahend, difference)
+ *
+ *     Stores a newly allocated Roman numeral for (minuend - subtrahend) in
+ *     *difference and returns RS_OK. If minuend is less than or equal to
+ *     subtrahend, *difference is set to NULL and RS_NOT_POSITIVE is returned;
+ *     if either input contains an ambiguous subtractive pair (see
+ *     is_ambiguous_pair), RS_INVALID_NUMERAL is returned instead.
+ *
+ *     Rather than borrowing one symbol at a time, this takes the difference of
+ *     the two inputs' tallies symbol by symbol, which may leave some counts
+ *     negative, and settles every carry and borrow in a single pass from I up
+ *     to M. Nothing is ever expanded into I's, so the only string built is the
+ *     result itself.
+ */
+enum Roman_Status try_subtract_roman_numerals(char *minuend, char *subtrahend,
+                                              char **difference)
+{
+    long symbol_counts[RN_LAST];
+    long subtrahend_counts[RN_LAST];
+    long long value = 0;
+    enum Roman_Numeral symbol;
+
+    *difference = NULL;
+
+    if (tally_numeral(minuend, symbol_counts) != RS_OK
+        || tally_numeral(subtrahend, subtrahend_counts) != RS_OK) {
+        return RS_INVALID_NUMERAL;
+    }
+    for (symbol = RN_I; symbol < RN_LAST; symbol++) {
+        symbol_counts[symbol] -= subtrahend_counts[symbol];
+        value += (long long) symbol_counts[symbol]
+                 * conversion_table[symbol][RN_I];
+    }
+
+    if (value <= 0) return RS_NOT_POSITIVE;
+
+    carry_symbol_counts(symbol_counts);
+    *difference = render_symbol_counts(symbol_counts);
+
+    return RS_OK;
+}
+
+/**
+ * set_roman_parallel_threshold(threshold)
+ *
+ * Sets the input length at which calculations switch to the chunked,
+ * multithreaded tally path described above PARALLEL_THRESHOLD, and returns the
+ * previous threshold. This is not synchronized, so call it before starting any
+ * calculations.
+ */
+size_t set_roman_parallel_threshold(size_t threshold)
+{
+    size_t previous = parallel_threshold;
+    parallel_threshold = threshold;
+    return previous;
+}
+
+/**
+ * set_roman_tally_threads(threads)
+ *
+ * Sets the number of threads (and so chunks) used to tally a numeral on the
+ * large-input path, and returns the previous setting. Zero means one per
+ * online processor; anything above MAX_TALLY_THREADS is capped. Like
+ * set_roman_parallel_threshold, this is not synchronized.
+ */
+size_t set_roman_tally_threads(size_t threads)
+{
+    size_t previous = tally_threads;
+    tally_threads = threads;
+    return previous;
+}
+
+/**
+ * roman_from_uint32_array(values, count, arena, arena_size, offsets)
+ *
+ * Writes each of the count integers in values into arena as a NUL-terminated
+ * Roman numeral, one after another. offsets must have room for count + 1
+ * entries: numeral i starts at arena + offsets[i], and offsets[count] is the
+ * total number of bytes used.
+ *
+ * The offsets are always filled in. If the numerals don't fit in arena_size
+ * bytes (or arena is NULL and any bytes are needed), nothing is written and
+ * RS_ARENA_FULL is returned, so passing a NULL arena is a way to size one.
+ * Zero has no Roman numeral; it is written as an empty string, and
+ * RS_NOT_POSITIVE is returned once the rest are written.
+ */
+enum Roman_Status roman_from_uint32_array(const uint32_t *values, size_t count,
+                                          char *arena, size_t arena_size,
+                                          size_t *offsets)
+{
+    enum Roman_Status status = RS_OK;
+    size_t i;
+
+    offsets[0] = 0;
+    for (i = 0; i < count; i++) {
+        offsets[i + 1] = offsets[i] + uint32_numeral_length(values[i]) + 1;
+    }
+    if (offsets[count] > arena_size || (!arena && offsets[count] > 0)) {
+        return RS_ARENA_FULL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (values[i] == 0) status = RS_NOT_POSITIVE;
+        *write_uint32_numeral(values[i], arena + offsets[i]) = '\0';
+    }
+
+    return status;
+}
+
+/**
+ * roman_to_uint32_array(arena, offsets, count, values)
+ *
+ * The inverse of roman_from_uint32_array: reads the NUL-terminated numerals
+ * starting at arena + offsets[i] for each i < count and stores their values
+ * in values. Numerals are read the same way the calculator reads its inputs,
+ * by tallying their additive forms, and the tally is converted straight to an
+ * integer without rendering it. A numeral that is empty, contains anything
+ * other than IVXLCDM, is ambiguous, or is too large for 32 bits is stored as
+ * 0, and the first such failure determines the returned status.
+ */
+enum Roman_Status roman_to_uint32_array(const char *arena,
+                                        const size_t *offsets, size_t count,
+                                        uint32_t *values)
+{
+    enum Roman_Status status = RS_OK;
+    enum Roman_Status record_status;
+    long symbol_counts[RN_LAST];
+    unsigned long long value;
+    const char *numeral;
+    size_t leading_Ms;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        numeral = arena + offsets[i];
+        record_status = RS_OK;
+        value = 0;
+
+        if (*numeral == '\0' || numeral[strspn(numeral, "IVXLCDM")] != '\0') {
+            record_status = RS_INVALID_NUMERAL;
+        } else {
+            // Large values are mostly M's; skip over those with strspn.
+            leading_Ms = strspn(numeral, "M");
+            record_status = tally_numeral(numeral + leading_Ms, symbol_counts);
+            symbol_counts[RN_M] += leading_Ms;
+            value = tally_value(symbol_counts);
+            if (record_status == RS_OK && value > UINT32_MAX) {
+                record_status = RS_OVERFLOW;
+            }
+            if (record_status != RS_OK) value = 0;
+        }
+
+        values[i] = (uint32_t) value;
+        if (status == RS_OK) status = record_status;
+    }
+
+    return status;
+}
+
+///
+/// Helper Functions
+///
+
+/**
+ * add_large_roman_numerals(augend, addend)
+ *
+ * The large-input counterpart to add_roman_numerals. Rather than building and
+ * rebundling the additive forms of augend and addend as strings, this tallies
+ * the symbols of both inputs (in parallel chunks), carries the tally into
+ * larger symbols and renders the result once.
+ */
+static char *add_large_roman_numerals(char *augend, char *addend)
+{
+    long symbol_counts[RN_LAST] = {0};
+    long addend_counts[RN_LAST];
+    size_t additive_length = 0;
+    enum Roman_Numeral symbol;
 
     /*
-     * Borrow from larger neighbors when a tally member is negative
+     * Every two characters of input account for at least one character of
+     * its additive form (VX becomes V), so inputs this long can be turned
+     * away without being read.
      */
-    for(symbol = RN_I; symbol < RN_LAST; symbol++) {
-        if (tally[symbol] < 0) {
-            symbolII = symbol;
-            while(symbolII++, (tally[symbol] < 0 && !(symbolII < RN_I)))
-            {
-                exchange_rate = conversion_table[symbolII][symbol];
-                if (tally[symbolII] * exchange_rate > 0) {
-                    tally[symbolII]--;
-                    tally[symbol] += exchange_rate;
-                    result_members += exchange_rate - 1;
-                }
-            }
+    if (strlen(augend) + strlen(addend) > 2 * (size_t) MAX_NUMERAL_LENGTH) {
+        perror("Error: Combined size of inputs exceeds MAX_NUMERAL_LENGTH.");
+        return INFINITAS;
+    }
+
+    if (tally_numeral(augend, symbol_counts) != RS_OK
+        || tally_numeral(addend, addend_counts) != RS_OK) {
+        return NULL;
+    }
+    for (symbol = RN_I; symbol < RN_LAST; symbol++) {
+        symbol_counts[symbol] += addend_counts[symbol];
+        additive_length += symbol_counts[symbol];
+    }
+
+    if (additive_length > MAX_NUMERAL_LENGTH) {
+        perror("Error: Combined size of inputs exceeds MAX_NUMERAL_LENGTH.");
+        return INFINITAS;
+    }
+
+    carry_symbol_counts(symbol_counts);
+    return render_symbol_counts(symbol_counts);
+}
+
+/**
+ * tally_numeral(numeral, symbol_counts)
+ *
+ * Stores in symbol_counts the number of each symbol appearing in the additive
+ * form of numeral, without building that form, and returns RS_OK. Numerals
+ * shorter than parallel_threshold are counted in the calling thread; longer
+ * ones are split into chunks that are counted concurrently and merged
+ * afterwards. Returns RS_INVALID_NUMERAL if numeral contains an ambiguous
+ * subtractive pair (see is_ambiguous_pair).
+ */
+static enum Roman_Status tally_numeral(const char *numeral,
+                                       long symbol_counts[])
+{
+    struct Tally_Chunk chunks[MAX_TALLY_THREADS];
+    pthread_t threads[MAX_TALLY_THREADS];
+    int spawned[MAX_TALLY_THREADS] = {0};
+    enum Roman_Status status = RS_OK;
+    size_t length = strlen(numeral);
+    const char *stop = numeral + length;
+    const char *cut;
+    long chunk_count = 1;
+    long i;
+    enum Roman_Numeral symbol;
+
+    pthread_once(&tally_tables_once, build_tally_tables);
+
+    if (length >= parallel_threshold) {
+        if (tally_threads > MAX_TALLY_THREADS) {
+            chunk_count = MAX_TALLY_THREADS;
+        } else if (tally_threads > 0) {
+            chunk_count = tally_threads;
+        } else {
+            chunk_count = sysconf(_SC_NPROCESSORS_ONLN);
         }
+        if (chunk_count < 1) chunk_count = 1;
+        if (chunk_count > MAX_TALLY_THREADS) chunk_count = MAX_TALLY_THREADS;
+        if ((size_t) chunk_count > length) chunk_count = length ? length : 1;
     }
 
     /*
-     * Use the tally to memset the correct number of I's into a result
-     * variable.
+     * Lay out the chunks back to back, nudging each cut forward until it no
+     * longer separates a symbol from a larger one that follows it.
      */
-    char *result = calloc(result_members, sizeof(char));
-    char *temp;
+    chunks[0].start = numeral;
+    for (i = 0; i < chunk_count; i++) {
+        chunks[i].numeral = numeral;
+        chunks[i].numeral_stop = stop;
+        if (i == chunk_count - 1) break;
+        cut = numeral + length / chunk_count * (i + 1);
+        chunks[i].stop = next_safe_boundary(cut, stop);
+        if (chunks[i].stop < chunks[i].start) chunks[i].stop = chunks[i].start;
+        chunks[i + 1].start = chunks[i].stop;
+    }
+    chunks[chunk_count - 1].stop = stop;
 
-    size_t offset = result_members - 1;
-    for(symbol = RN_I; symbol < RN_LAST; symbol++) {
-        offset -= tally[symbol];
-        memset(result + offset, roman_numeral_chars[symbol], tally[symbol]);
+    // Count the first chunk here and farm out the rest.
+    for (i = 1; i < chunk_count; i++) {
+        spawned[i] = !pthread_create(&threads[i], NULL, tally_chunk,
+                                     &chunks[i]);
     }
+    tally_chunk(&chunks[0]);
 
-    // Bundle smaller numerals into larger ones
-    temp = bundle_roman_symbols(result);
-    result = free_and_reassign(&result, &temp);
+    memset(symbol_counts, 0, RN_LAST * sizeof(long));
+    for (i = 0; i < chunk_count; i++) {
+        if (spawned[i]) {
+            pthread_join(threads[i], NULL);
+        } else if (i > 0) {
+            tally_chunk(&chunks[i]);
+        }
+        if (chunks[i].ambiguous) status = RS_INVALID_NUMERAL;
+        for (symbol = RN_I; symbol < RN_LAST; symbol++) {
+            symbol_counts[symbol] += chunks[i].symbol_counts[symbol];
+        }
+    }
 
-    // Substitute subtractive forms into result and finish
-    temp = write_subtractively(result);
-    result = free_and_reassign(&result, &temp);
+    return status;
+}
 
-    return result;
+/**
+ * build_tally_tables()
+ *
+ * Fills in symbol_keys, subtractive_pair_form and subtractive_form_counts from
+ * roman_numeral_chars and the subtractive form tables. Run once, through
+ * pthread_once, before anything is tallied.
+ */
+static void build_tally_tables(void)
+{
+    enum Roman_Numeral symbol, symbolII;
+    enum Subtractive_Form form;
+    const char *pair;
+    const char *substitute;
+
+    memset(symbol_keys, RN_M, sizeof(symbol_keys));
+    for (symbol = RN_I; symbol < RN_LAST; symbol++) {
+        symbol_keys[(unsigned char) roman_numeral_chars[symbol]] = symbol;
+        for (symbolII = RN_I; symbolII < RN_LAST; symbolII++) {
+            subtractive_pair_form[symbol][symbolII] = SF_LAST;
+        }
+    }
+
+    for (form = SF_IV; form < SF_LAST; form++) {
+        pair = subtractive_form_string[form];
+        symbol = symbol_keys[(unsigned char) pair[0]];
+        symbolII = symbol_keys[(unsigned char) pair[1]];
+        subtractive_pair_form[symbol][symbolII] = form;
+        for (substitute = subtractive_substitute_string[form]; *substitute;
+             substitute++) {
+            symbol = symbol_keys[(unsigned char) *substitute];
+            subtractive_form_counts[form][symbol]++;
+        }
+    }
 }
 
-///
-/// Helper Functions
-///
+/**
+ * next_safe_boundary(position, stop)
+ *
+ * Returns the first position at or after position (and no later than stop)
+ * where a numeral can be cut without splitting a subtractive pair, i.e., where
+ * the preceding symbol is at least as large as the one that follows it.
+ */
+static const char *next_safe_boundary(const char *position, const char *stop)
+{
+    while (position < stop
+           && symbol_keys[(unsigned char) position[-1]]
+              < symbol_keys[(unsigned char) *position]) {
+        position++;
+    }
+    return position;
+}
+
+/**
+ * tally_chunk(chunk)
+ *
+ * Fills in chunk->symbol_counts with the symbols appearing in the additive form
+ * of the numeral between chunk->start and chunk->stop, reading each symbol that
+ * is followed by a larger one as a subtractive pair. Stops early and sets
+ * chunk->ambiguous if one of those pairs is ambiguous. Has the signature of a
+ * pthread start routine.
+ */
+static void *tally_chunk(void *chunk_ptr)
+{
+    struct Tally_Chunk *chunk = chunk_ptr;
+    const char *position = chunk->start;
+    const long *form_counts;
+    enum Roman_Numeral symbol, next_symbol;
+    enum Subtractive_Form form;
+
+    memset(chunk->symbol_counts, 0, sizeof(chunk->symbol_counts));
+    chunk->ambiguous = 0;
+    while (position < chunk->stop) {
+        symbol = symbol_keys[(unsigned char) position[0]];
+        next_symbol = (position + 1 < chunk->stop)
+                      ? symbol_keys[(unsigned char) position[1]]
+                      : symbol;
+        if (symbol >= next_symbol) {
+            chunk->symbol_counts[symbol]++;
+            position++;
+            continue;
+        }
+
+        if (is_ambiguous_pair(position, chunk->numeral, chunk->numeral_stop)) {
+            chunk->ambiguous = 1;
+            break;
+        }
+        form = subtractive_pair_form[symbol][next_symbol];
+        form_counts = subtractive_form_counts[form];
+        for (symbol = RN_I; symbol < RN_LAST; symbol++) {
+            chunk->symbol_counts[symbol] += form_counts[symbol];
+        }
+        position += 2; // Both symbols of the pair
+    }
+
+    return NULL;
+}
+
+/**
+ * is_ambiguous_numeral(numeral)
+ *
+ * Returns nonzero if any subtractive pair in numeral is ambiguous in the sense
+ * of is_ambiguous_pair.
+ */
+static int is_ambiguous_numeral(const char *numeral)
+{
+    const char *stop = numeral + strlen(numeral);
+    const char *position;
+
+    pthread_once(&tally_tables_once, build_tally_tables);
+    for (position = numeral; position + 1 < stop; position++) {
+        if (symbol_keys[(unsigned char) position[0]]
+                < symbol_keys[(unsigned char) position[1]]
+            && is_ambiguous_pair(position, numeral, stop)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * is_ambiguous_pair(pair, numeral, stop)
+ *
+ * Given a subtractive pair at pair inside the numeral [numeral, stop), returns
+ * nonzero if the pair is preceded by a symbol lying strictly between its two
+ * symbols (as in LIC) or followed by a symbol larger than both (as in IVX).
+ * These are exactly the places where reading pairs from left to right, as the
+ * tally does, can disagree with the pass-by-pass substitutions made by
+ * write_additively, so the calculator refuses such numerals on every path
+ * rather than giving answers that depend on input length.
+ */
+static int is_ambiguous_pair(const char *pair, const char *numeral,
+                             const char *stop)
+{
+    enum Roman_Numeral lesser = symbol_keys[(unsigned char) pair[0]];
+    enum Roman_Numeral greater = symbol_keys[(unsigned char) pair[1]];
+    enum Roman_Numeral neighbour;
+
+    if (pair > numeral) {
+        neighbour = symbol_keys[(unsigned char) pair[-1]];
+        if (lesser < neighbour && neighbour < greater) return 1;
+    }
+    return pair + 2 < stop && symbol_keys[(unsigned char) pair[2]] > greater;
+}
+
+/**
+ * carry_symbol_counts(symbol_counts)
+ *
+ * The tally equivalent of bundle_roman_symbols: trades every complete group of
+ * a symbol for one copy of the next most significant symbol, working upwards
+ * from I using the rates in conversion_table. Negative counts (as left behind
+ * by subtraction) borrow from the next symbol instead, so that afterwards every
+ * count below M lies between zero and its exchange rate.
+ */
+static void carry_symbol_counts(long symbol_counts[])
+{
+    enum Roman_Numeral symbol;
+    long exchange_rate;
+    long carry;
+
+    for (symbol = RN_I; symbol < RN_M; symbol++) {
+        exchange_rate = conversion_table[symbol + 1][symbol];
+        carry = symbol_counts[symbol] / exchange_rate;
+        if (symbol_counts[symbol] % exchange_rate < 0) carry--;
+        symbol_counts[symbol] -= carry * exchange_rate;
+        symbol_counts[symbol + 1] += carry;
+    }
+}
+
+/**
+ * tally_value(symbol_counts)
+ *
+ * Returns the integer represented by a tally, reading the value of each symbol
+ * off the I column of conversion_table.
+ */
+static unsigned long long tally_value(const long symbol_counts[])
+{
+    unsigned long long value = 0;
+    enum Roman_Numeral symbol;
+
+    for (symbol = RN_I; symbol < RN_LAST; symbol++) {
+        value += (unsigned long long) symbol_counts[symbol]
+                 * conversion_table[symbol][RN_I];
+    }
+    return value;
+}
+
+/**
+ * uint32_numeral_length(value)
+ *
+ * Returns the length of the Roman numeral for value, not counting the
+ * terminating '\0'.
+ */
+static size_t uint32_numeral_length(uint32_t value)
+{
+    return value / 1000
+           + roman_digit_lengths[value / 100 % 10]
+           + roman_digit_lengths[value / 10 % 10]
+           + roman_digit_lengths[value % 10];
+}
+
+/**
+ * write_uint32_numeral(value, destination)
+ *
+ * Writes the Roman numeral for value to destination without a terminating
+ * '\0' and returns a pointer just past its last character.
+ */
+static char *write_uint32_numeral(uint32_t value, char *destination)
+{
+    size_t thousands = value / 1000;
+    uint32_t place_value = 100;
+    int place;
+    uint32_t digit;
+
+    memset(destination, roman_numeral_chars[RN_M], thousands);
+    destination += thousands;
+
+    for (place = 2; place >= 0; place--, place_value /= 10) {
+        digit = value / place_value % 10;
+        memcpy(destination, roman_digits[place][digit],
+               roman_digit_lengths[digit]);
+        destination += roman_digit_lengths[digit];
+    }
+
+    return destination;
+}
+
+/**
+ * render_symbol_counts(symbol_counts)
+ *
+ * Returns a newly allocated Roman numeral for a carried tally. Once carried,
+ * each place below M holds a single decimal digit (e.g., D * 5 + C hundreds),
+ * so the M's are written with memset and each remaining place is copied from
+ * roman_digits, straight into a buffer of exactly the right size.
+ */
+static char *render_symbol_counts(long symbol_counts[])
+{
+    size_t digits[ROMAN_DIGIT_PLACES];
+    size_t length = symbol_counts[RN_M];
+    const int places = ROMAN_DIGIT_PLACES;
+    enum Roman_Numeral one, five;
+    int place;
+
+    for (place = 0; place < places; place++) {
+        one = 2 * place;
+        five = one + 1;
+        digits[place] = symbol_counts[five] * conversion_table[five][one]
+                        + symbol_counts[one];
+        length += roman_digit_lengths[digits[place]];
+    }
+
+    char *result = malloc(length + 1);
+    char *destination = result + symbol_counts[RN_M];
+    memset(result, roman_numeral_chars[RN_M], symbol_counts[RN_M]);
+    while (place-- > 0) {
+        memcpy(destination, roman_digits[place][digits[place]],
+               roman_digit_lengths[digits[place]]);
+        destination += roman_digit_lengths[digits[place]];
+    }
+    *destination = '\0';
+
+    return result;
+}
 
 /**
  * write_additively(roman_numeral)
@@ -1,5 +1,26 @@
 #ifndef ROMAN_CALCULATOR_H
 #define ROMAN_CALCULATOR_H
+#include <stddef.h>
+#include <stdint.h>
+
+enum Roman_Status {
+    RS_OK,
+    RS_NOT_POSITIVE,
+    RS_INVALID_NUMERAL,
+    RS_OVERFLOW,
+    RS_ARENA_FULL
+};
+
 char *add_roman_numerals(char *augend, char *addend);
 char *subtract_roman_numerals(char *minuend, char *subtrahend);
+enum Roman_Status try_subtract_roman_numerals(char *minuend, char *subtrahend,
+                                              char **difference);
+size_t set_roman_parallel_threshold(size_t threshold);
+size_t set_roman_tally_threads(size_t threads);
+enum Roman_Status roman_from_uint32_array(const uint32_t *values, size_t count,
+                                          char *arena, size_t arena_size,
+                                          size_t *offsets);
+enum Roman_Status roman_to_uint32_array(const char *arena,
+                                        const size_t *offsets, size_t count,
+                                        uint32_t *values);
 #endif /* ROMAN_CALCULATOR_H */
@@ -188,6 +188,246 @@ START_TEST(ID_minus_XLV_is_CDLIV)
 }
 END_TEST
 
+START_TEST(M_minus_I_is_CMXCIX)
+{
+    char *result = subtract_roman_numerals("M", "I");
+    ck_assert_str_eq(result, "CMXCIX");
+    free(result);
+}
+END_TEST
+
+START_TEST(MMMMMMMMMM_minus_XLIX_borrows_across_every_symbol)
+{
+    char *result = subtract_roman_numerals("MMMMMMMMMM", "XLIX");
+    ck_assert_str_eq(result, "MMMMMMMMMCMLI");
+    free(result);
+}
+END_TEST
+
+START_TEST(differences_that_are_not_positive_are_reported)
+{
+    char *difference = "unchanged";
+
+    ck_assert_int_eq(try_subtract_roman_numerals("XIV", "XIV", &difference),
+                     RS_NOT_POSITIVE);
+    ck_assert_ptr_eq(difference, NULL);
+    ck_assert_int_eq(try_subtract_roman_numerals("IX", "X", &difference),
+                     RS_NOT_POSITIVE);
+    ck_assert_ptr_eq(subtract_roman_numerals("IX", "X"), NULL);
+
+    ck_assert_int_eq(try_subtract_roman_numerals("X", "IX", &difference), RS_OK);
+    ck_assert_str_eq(difference, "I");
+    free(difference);
+}
+END_TEST
+
+/**
+ * Large-input tests begin here. Lowering the parallel threshold forces small
+ * inputs through the chunked tally path, and fixing the number of tally
+ * threads makes sure they really are split into chunks (and counted on
+ * separate threads) however many processors the test machine has. The output
+ * should agree with the string-based path.
+ */
+START_TEST(chunked_sums_agree_with_the_string_based_sums)
+{
+    char *summands[][2] = {
+        {"I", "I"}, {"IV", "II"}, {"VII", "VIII"}, {"ID", "XLV"},
+        {"MCMXCIX", "I"}, {"M", "DCCCCLXXXXVIIII"}, {"IIIIIIIII", "V"},
+        {"IVX", "I"}, {"MLIC", "I"}
+    };
+    int number_of_sums = 9;
+    size_t old_threshold, old_threads;
+    char *expected, *result;
+
+    int i;
+    for (i = 0; i < number_of_sums; i++) {
+        expected = add_roman_numerals(summands[i][0], summands[i][1]);
+        old_threshold = set_roman_parallel_threshold(1);
+        old_threads = set_roman_tally_threads(3);
+        result = add_roman_numerals(summands[i][0], summands[i][1]);
+        set_roman_tally_threads(old_threads);
+        set_roman_parallel_threshold(old_threshold);
+        if (expected) {
+            ck_assert_str_eq(result, expected);
+        } else {
+            ck_assert_ptr_eq(result, NULL);
+        }
+        free(expected);
+        free(result);
+    }
+}
+END_TEST
+
+START_TEST(long_numerals_are_not_split_inside_subtractive_forms)
+{
+    // 100 copies each of CM, XC and IX make 99900, and adding II gives 99902.
+    char augend[3 * 2 * 100 + 1] = {'\0'};
+    char expected[99 + 4 + 1];
+    size_t old_threshold, old_threads, threads;
+    char *result;
+    int i;
+    for (i = 0; i < 100; i++) {
+        strcat(augend, "CM");
+    }
+    for (i = 0; i < 100; i++) {
+        strcat(augend, "XC");
+    }
+    for (i = 0; i < 100; i++) {
+        strcat(augend, "IX");
+    }
+    memset(expected, 'M', 99);
+    strcpy(expected + 99, "CMII");
+
+    /*
+     * Splitting 600 characters evenly between 2, 3, ..., 64 threads puts
+     * plenty of the initial cuts inside CM, XC and IX.
+     */
+    old_threshold = set_roman_parallel_threshold(1);
+    for (threads = 2; threads <= 64; threads++) {
+        old_threads = set_roman_tally_threads(threads);
+        result = add_roman_numerals(augend, "II");
+        set_roman_tally_threads(old_threads);
+        ck_assert_str_eq(result, expected);
+        free(result);
+    }
+    set_roman_parallel_threshold(old_threshold);
+}
+END_TEST
+
+START_TEST(ambiguous_numerals_are_refused_on_every_path)
+{
+    char *difference;
+    char arena[] = "IVX\0MMLIC\0";
+    size_t offsets[] = {0, 4};
+    uint32_t parsed[2];
+    size_t old_threshold, old_threads;
+
+    ck_assert_ptr_eq(add_roman_numerals("IVX", "I"), NULL);
+    ck_assert_int_eq(try_subtract_roman_numerals("MLIC", "I", &difference),
+                     RS_INVALID_NUMERAL);
+    ck_assert_ptr_eq(difference, NULL);
+    ck_assert_int_eq(roman_to_uint32_array(arena, offsets, 2, parsed),
+                     RS_INVALID_NUMERAL);
+    ck_assert_int_eq(parsed[0], 0);
+    ck_assert_int_eq(parsed[1], 0);
+
+    // The ambiguity in LIC straddles the cuts between L and I.
+    old_threshold = set_roman_parallel_threshold(1);
+    old_threads = set_roman_tally_threads(5);
+    ck_assert_ptr_eq(add_roman_numerals("LICLICLIC", "I"), NULL);
+    set_roman_tally_threads(old_threads);
+    set_roman_parallel_threshold(old_threshold);
+}
+END_TEST
+
+/**
+ * Integer interop tests begin here
+ */
+START_TEST(roman_from_uint32_array_packs_numerals_into_the_arena)
+{
+    uint32_t values[] = {1, 4, 1999, 3888};
+    char arena[32];
+    size_t offsets[5];
+
+    ck_assert_int_eq(roman_from_uint32_array(values, 4, arena, sizeof(arena),
+                                             offsets), RS_OK);
+    ck_assert_str_eq(arena + offsets[0], "I");
+    ck_assert_str_eq(arena + offsets[1], "IV");
+    ck_assert_str_eq(arena + offsets[2], "MCMXCIX");
+    ck_assert_str_eq(arena + offsets[3], "MMMDCCCLXXXVIII");
+    ck_assert_int_eq(offsets[4], 2 + 3 + 8 + 16);
+}
+END_TEST
+
+START_TEST(roman_from_uint32_array_reports_the_size_of_a_full_arena)
+{
+    uint32_t values[] = {8, 2000};
+    char arena[4];
+    size_t offsets[3];
+
+    ck_assert_int_eq(roman_from_uint32_array(values, 2, NULL, 0, offsets),
+                     RS_ARENA_FULL);
+    ck_assert_int_eq(offsets[2], 5 + 3);
+    ck_assert_int_eq(roman_from_uint32_array(values, 2, arena, sizeof(arena),
+                                             offsets), RS_ARENA_FULL);
+
+    // An empty batch needs no arena at all.
+    ck_assert_int_eq(roman_from_uint32_array(values, 0, NULL, 0, offsets), RS_OK);
+    ck_assert_int_eq(offsets[0], 0);
+}
+END_TEST
+
+START_TEST(zero_has_no_roman_numeral)
+{
+    uint32_t values[] = {0, 5};
+    uint32_t parsed[2];
+    char arena[8];
+    size_t offsets[3];
+
+    ck_assert_int_eq(roman_from_uint32_array(values, 2, arena, sizeof(arena),
+                                             offsets), RS_NOT_POSITIVE);
+    ck_assert_str_eq(arena + offsets[0], "");
+    ck_assert_str_eq(arena + offsets[1], "V");
+    ck_assert_int_eq(roman_to_uint32_array(arena, offsets, 2, parsed),
+                     RS_INVALID_NUMERAL);
+    ck_assert_int_eq(parsed[0], 0);
+    ck_assert_int_eq(parsed[1], 5);
+}
+END_TEST
+
+START_TEST(roman_to_uint32_array_reads_back_every_rendered_value)
+{
+    uint32_t values[3999], parsed[3999];
+    size_t offsets[3999 + 1];
+    char *arena;
+    uint32_t i;
+
+    for (i = 0; i < 3999; i++) {
+        values[i] = i + 1;
+    }
+    roman_from_uint32_array(values, 3999, NULL, 0, offsets);
+    arena = malloc(offsets[3999]);
+    ck_assert_int_eq(roman_from_uint32_array(values, 3999, arena, offsets[3999],
+                                             offsets), RS_OK);
+    ck_assert_int_eq(roman_to_uint32_array(arena, offsets, 3999, parsed), RS_OK);
+    for (i = 0; i < 3999; i++) {
+        ck_assert_int_eq(parsed[i], values[i]);
+    }
+    free(arena);
+}
+END_TEST
+
+START_TEST(roman_to_uint32_array_accepts_what_the_calculator_accepts)
+{
+    char arena[] = "IIIIIIIII\0IM\0XLV\0IVX?\0";
+    size_t offsets[] = {0, 10, 13, 17};
+    uint32_t parsed[4];
+
+    ck_assert_int_eq(roman_to_uint32_array(arena, offsets, 4, parsed),
+                     RS_INVALID_NUMERAL);
+    ck_assert_int_eq(parsed[0], 9);
+    ck_assert_int_eq(parsed[1], 999);
+    ck_assert_int_eq(parsed[2], 45);
+    ck_assert_int_eq(parsed[3], 0);
+}
+END_TEST
+
+START_TEST(sums_render_the_same_way_as_integers)
+{
+    uint32_t values[] = {1999 + 1, 1444 + 2555};
+    char arena[32];
+    size_t offsets[3];
+    char *resultI = add_roman_numerals("MCMXCIX", "I");
+    char *resultII = add_roman_numerals("MCDXLIV", "MMDLV");
+
+    roman_from_uint32_array(values, 2, arena, sizeof(arena), offsets);
+    ck_assert_str_eq(resultI, arena + offsets[0]);
+    ck_assert_str_eq(resultII, arena + offsets[1]);
+    free(resultI);
+    free(resultII);
+}
+END_TEST
+
 Suite *create_drmrd_roman_calculator_suite(void)
 {
     // Create our primary testing suite.
@@ -199,6 +439,8 @@ Suite *create_drmrd_roman_calculator_suite(void)
      */
     TCase *tc_addition = tcase_create("Addition");
     TCase *tc_subtraction = tcase_create("Subtraction");
+    TCase *tc_large_numerals = tcase_create("Large Numerals");
+    TCase *tc_integer_interop = tcase_create("Integer Interop");
 
     // Populate our addition test case with test functions
     tcase_add_test(tc_addition, add_roman_numerals_accepts_two_strings_consisting_of_symbols_IVXLCDM);
@@ -217,10 +459,28 @@ Suite *create_drmrd_roman_calculator_suite(void)
     tcase_add_test(tc_subtraction, M_minus_D_is_D);
     tcase_add_test(tc_subtraction, X_minus_I_is_IX);
     tcase_add_test(tc_subtraction, ID_minus_XLV_is_CDLIV);
+    tcase_add_test(tc_subtraction, M_minus_I_is_CMXCIX);
+    tcase_add_test(tc_subtraction, MMMMMMMMMM_minus_XLIX_borrows_across_every_symbol);
+    tcase_add_test(tc_subtraction, differences_that_are_not_positive_are_reported);
+
+    // Populate our large numeral test case with test functions
+    tcase_add_test(tc_large_numerals, chunked_sums_agree_with_the_string_based_sums);
+    tcase_add_test(tc_large_numerals, long_numerals_are_not_split_inside_subtractive_forms);
+    tcase_add_test(tc_large_numerals, ambiguous_numerals_are_refused_on_every_path);
+
+    // Populate our integer interop test case with test functions
+    tcase_add_test(tc_integer_interop, roman_from_uint32_array_packs_numerals_into_the_arena);
+    tcase_add_test(tc_integer_interop, roman_from_uint32_array_reports_the_size_of_a_full_arena);
+    tcase_add_test(tc_integer_interop, zero_has_no_roman_numeral);
+    tcase_add_test(tc_integer_interop, roman_to_uint32_array_reads_back_every_rendered_value);
+    tcase_add_test(tc_integer_interop, roman_to_uint32_array_accepts_what_the_calculator_accepts);
+    tcase_add_test(tc_integer_interop, sums_render_the_same_way_as_integers);
 
     // Add our test cases to test_suite
     suite_add_tcase(test_suite, tc_addition);
     suite_add_tcase(test_suite, tc_subtraction);
+    suite_add_tcase(test_suite, tc_large_numerals);
+    suite_add_tcase(test_suite, tc_integer_interop);
 
     return test_suite;
 }